@@ -0,0 +1,183 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <charconv>
+#include "scene-name-parser.hpp"
+#include "scene-name-columns.hpp"
+
+#ifndef SCENE_NAME_PARSER_BUILD_LABEL
+#define SCENE_NAME_PARSER_BUILD_LABEL "unlabeled"
+#endif
+
+/*
+ * Benchmarks the parser on the perf corpus (perf/release_names.txt, one release name per line).
+ *
+ * With --results, the time per name is recorded under the label of this build (the CMake preset name),
+ * and a table with the speedup of every recorded build compared to the "release" preset is printed.
+ * Running the bench target of each preset one after another thus compares LTO/PGO against the plain build.
+ */
+
+void print_help() {
+    std::cout << "Usage:" << std::endl;
+    std::cout << "scene_name_parser_bench [corpus] [--iterations n] [--results file]" << std::endl;
+}
+
+/**
+ * Parses a whole argument as a number, unlike std::stoul which throws on garbage and ignores trailing characters
+ * @return if value was a valid number
+ */
+bool parse_number(const std::string &value, std::size_t &number) {
+    const char *last = value.data() + value.size();
+    auto [end, error] = std::from_chars(value.data(), last, number);
+    return error == std::errc() && end == last && !value.empty();
+}
+
+std::vector<std::string> load_corpus(const std::string &path) {
+    std::vector<std::string> names;
+    std::ifstream corpus(path);
+    std::string line;
+    while (std::getline(corpus, line)) {
+        if (!line.empty()) {
+            names.push_back(line);
+        }
+    }
+    return names;
+}
+
+/**
+ * Stores the result of this build in the results file, replacing an older result of the same label.
+ * Lines of the file that aren't "label ns_per_name" are skipped, so one bad line can't drop the others.
+ * @return all results within the file, label -> nanoseconds per name
+ */
+std::map<std::string, double> record_result(const std::string &path, const std::string &label, double ns_per_name) {
+    std::map<std::string, double> results;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string recorded_label;
+        double recorded_ns;
+        if (fields >> recorded_label >> recorded_ns) {
+            results[recorded_label] = recorded_ns;
+        }
+    }
+    in.close();
+
+    results[label.empty() ? "default" : label] = ns_per_name;
+
+    std::ofstream out(path, std::ios::trunc);
+    for (auto &result: results) {
+        out << result.first << " " << result.second << std::endl;
+    }
+    return results;
+}
+
+int main(int argc, char *argv[]) {
+    std::string corpus_path = "perf/release_names.txt";
+    std::string results_path;
+    std::size_t iterations = 50;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            if (!parse_number(argv[++i], iterations) || iterations == 0) {
+                std::cout << "Invalid number of iterations " << argv[i] << std::endl;
+                print_help();
+                return 1;
+            }
+        } else if (arg == "--results" && i + 1 < argc) {
+            results_path = argv[++i];
+        } else if (arg == "--help") {
+            print_help();
+            return 0;
+        } else {
+            corpus_path = arg;
+        }
+    }
+
+    std::vector<std::string> corpus = load_corpus(corpus_path);
+    if (corpus.empty()) {
+        std::cout << "Could not load corpus " << corpus_path << std::endl;
+        return 1;
+    }
+
+    scene_name::scene_name_parser parser;
+
+    // warmup, also counts the names of the corpus the parser can't handle
+    std::size_t failed = 0;
+    for (auto &name: corpus) {
+        if (parser.parse(name).second != scene_name::parsing_result::pr_success) {
+            failed++;
+        }
+    }
+
+    // accumulated so the optimizer can't throw the parsing away
+    std::size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t iteration = 0; iteration < iterations; iteration++) {
+        for (auto &name: corpus) {
+            auto parse_result = parser.parse(name);
+            checksum += parse_result.first.has_value() ? parse_result.first->name.size() : 0;
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // the same corpus as one batch, which skips delimiter detection for names following the dominant layout
+    auto batch_start = std::chrono::steady_clock::now();
+    for (std::size_t iteration = 0; iteration < iterations; iteration++) {
+        for (auto &parse_result: parser.parse_batch(corpus)) {
+            checksum += parse_result.first.has_value() ? parse_result.first->name.size() : 0;
+        }
+    }
+    auto batch_elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - batch_start).count();
+
+    double ns_per_name = elapsed / static_cast<double>(iterations * corpus.size());
+    double batch_ns_per_name = batch_elapsed / static_cast<double>(iterations * corpus.size());
+
+    std::cout << "Build: " << SCENE_NAME_PARSER_BUILD_LABEL << std::endl;
+    std::cout << "Names: " << corpus.size() << " x " << iterations << " iterations, " << failed << " failed"
+              << std::endl;
+    std::cout << "Time per name: " << ns_per_name << " ns" << std::endl;
+    std::cout << "Throughput: " << static_cast<std::size_t>(1e9 / ns_per_name) << " names/s" << std::endl;
+    std::cout << "Time per name, as batch: " << batch_ns_per_name << " ns" << std::endl;
+    std::cout << "Checksum: " << checksum << std::endl;
+
+    // filtering the structure of arrays layout, with the rows of the corpus repeated to a million rows.
+    // The corpus is parsed only once, so the fill doesn't dwarf the timings above (and the PGO training).
+    auto corpus_results = parser.parse_batch(corpus);
+    scene_release_info::release_columns columns;
+    columns.reserve(1000000);
+    while (columns.size() < 1000000) {
+        for (auto &parse_result: corpus_results) {
+            columns.push_back(parse_result.first);
+        }
+    }
+    auto filter_start = std::chrono::steady_clock::now();
+    auto selection = scene_name::select_all(columns);
+    scene_name::filter_resolution(columns, scene_release_info::resolution_info::ri_2160, selection);
+    scene_name::filter_container(columns, scene_release_info::container_type::ct_h265, selection);
+    scene_name::filter_source(columns, scene_release_info::media_source::ms_web, selection);
+    scene_name::filter_year_at_least(columns, 2020, selection);
+    std::size_t selected = scene_name::count_selected(selection);
+    auto filter_elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - filter_start).count();
+    std::cout << "Filtering " << columns.size() << " rows for 2160p HEVC WEB 2020+: " << filter_elapsed << " ms, "
+              << selected << " selected" << std::endl;
+
+    if (!results_path.empty()) {
+        auto results = record_result(results_path, SCENE_NAME_PARSER_BUILD_LABEL, ns_per_name);
+        auto baseline = results.find("release");
+        double baseline_ns = (baseline != results.end()) ? baseline->second : ns_per_name;
+
+        std::cout << std::endl << "Speedup compared to release:" << std::endl;
+        for (auto &result: results) {
+            std::cout << result.first << ": " << result.second << " ns/name, "
+                      << baseline_ns / result.second << "x" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,607 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include "scene-name-parser.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define SCENE_NAME_PARSER_HAS_PIPE
+#endif
+
+/*
+ * Load generator for sizing hardware and finding scaling cliffs.
+ *
+ * Synthesizes release names at a configurable mix and drives the parser through
+ * - single: parse() per name, on every thread count
+ * - batch: parse_batch() on chunks of names, on every thread count
+ * - pipe: names written into an OS pipe line by line, read by one thread and parsed by the workers
+ *
+ * For each mode and thread count it prints throughput, speedup over a single thread and latency percentiles.
+ * With --shared-parser all threads use the same parser instance, which shows whether the parser has shared state.
+ */
+
+enum class name_category {
+    nc_movie = 0,
+    nc_show,
+    nc_no_year,
+    nc_delimiter,
+    nc_long_tail
+};
+
+const std::vector<std::string> CATEGORY_NAMES{"movies", "shows", "no-year", "delimiters", "long-tail"};
+
+/**
+ * Synthesizes realistic release names
+ */
+class release_name_generator {
+private:
+    std::mt19937_64 _random;
+    std::discrete_distribution<int> _categories;
+
+    const std::vector<std::string> _words{
+            "Random", "Silent", "Dark", "Last", "Night", "Edge", "City", "River", "Black", "Winter", "Golden",
+            "Broken", "Iron", "Shadow", "House", "Road", "Star", "Fire", "Lost", "Empire", "Secret", "Wild",
+            "Blue", "Red", "Dead", "King", "Queen", "Girl", "Man", "Storm", "Ocean", "Machine", "Dream", "Time"
+    };
+    const std::vector<std::string> _groups{
+            "ReleaseGroup", "SPARKS", "GECKOS", "FLUX", "NTb", "playWEB", "DRONES", "ROVERS", "AMIABLE", "SiGMA"
+    };
+    const std::vector<std::string> _languages{"", "German", "German.DL", "French", "MULTi"};
+    const std::vector<std::string> _editions{"", "", "", "EXTENDED", "DIRECTORS.CUT"};
+    const std::vector<std::string> _resolutions{"720p", "1080p", "2160p", "UHD"};
+    const std::vector<std::string> _sources{"BluRay", "WEB", "WEBRip", "WebUHD", "BDRip", "AMZN.WEB-DL"};
+    const std::vector<std::string> _codecs{"x264", "x265", "H264", "HEVC", "AVC"};
+    const std::vector<std::string> _tail_features{
+            "DD51", "DD71", "DTS", "Atmos", "TrueHD", "AAC", "HDR", "HDR10", "DV", "10bit", "REMUX", "PROPER",
+            "REPACK", "iNTERNAL", "LiMiTED", "SUBBED", "DUBBED", "NF", "DSNP"
+    };
+
+    const std::string &pick(const std::vector<std::string> &values) {
+        return values[std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(_random)];
+    }
+
+    int number(int min, int max) {
+        return std::uniform_int_distribution<int>(min, max)(_random);
+    }
+
+    static std::string two_digits(int value) {
+        return (value < 10 ? "0" : "") + std::to_string(value);
+    }
+
+    std::string title() {
+        std::string title = pick(_words);
+        for (int i = number(0, 3); i > 0; i--) {
+            title += "." + pick(_words);
+        }
+        return title;
+    }
+
+    std::string features(std::size_t extra_features) {
+        std::string features;
+        auto append = [&](const std::string &feature) {
+            if (!feature.empty()) {
+                features += feature + ".";
+            }
+        };
+        append(pick(_editions));
+        append(pick(_languages));
+        for (std::size_t i = 0; i < extra_features; i++) {
+            append(pick(_tail_features));
+        }
+        append(pick(_resolutions));
+        append(pick(_sources));
+        return features + pick(_codecs) + "-" + pick(_groups);
+    }
+
+    std::string show_marker() {
+        std::string marker = "S" + two_digits(number(1, 15)) + "E" + two_digits(number(1, 20));
+        switch (number(0, 5)) {
+            case 0:
+                return marker + "E" + two_digits(number(21, 24));
+            case 1:
+                return marker + "-E" + two_digits(number(21, 24));
+            default:
+                return marker;
+        }
+    }
+
+public:
+    /**
+     * @param weights weight of each name_category
+     */
+    release_name_generator(uint64_t seed, const std::vector<double> &weights)
+            : _random(seed), _categories(weights.begin(), weights.end()) {
+    }
+
+    std::string next() {
+        switch (static_cast<name_category>(_categories(_random))) {
+            case name_category::nc_movie:
+                return title() + "." + std::to_string(number(1950, 2024)) + "." + features(number(0, 2));
+            case name_category::nc_show:
+                return title() + "." + show_marker() + "." + features(number(0, 2));
+            case name_category::nc_no_year:
+                return title() + "." + features(number(0, 2));
+            case name_category::nc_delimiter: {
+                std::string name = title() + "." + std::to_string(number(1950, 2024)) + "." + features(number(0, 2));
+                char delimiter = number(0, 1) ? ' ' : '_';
+                std::replace(name.begin(), name.end(), '.', delimiter);
+                return name;
+            }
+            case name_category::nc_long_tail:
+                return title() + "." + std::to_string(number(1950, 2024)) + "." + features(number(8, 15));
+        }
+        return "";
+    }
+};
+
+struct run_result {
+    std::size_t threads = 0;
+    std::size_t names = 0;
+    double seconds = 0;
+    std::vector<double> latencies_ns; // per name, or per batch in batch mode
+};
+
+struct load_options {
+    std::size_t names = 200000;
+    uint64_t seed = 42;
+    std::vector<double> mix{40, 30, 10, 10, 10};
+    std::vector<std::size_t> threads;
+    std::vector<std::string> modes{"single", "batch", "pipe"};
+    std::size_t batch_size = 256;
+    bool shared_parser = false;
+    bool emit = false;
+};
+
+void print_help() {
+    std::cout << "Usage:" << std::endl;
+    std::cout << "scene_name_parser_loadgen [options]" << std::endl;
+    std::cout << "  --names n              number of names to synthesize (default 200000)" << std::endl;
+    std::cout << "  --seed n               seed for the synthesized names (default 42)" << std::endl;
+    std::cout << "  --mix movies=40,shows=30,no-year=10,delimiters=10,long-tail=10" << std::endl;
+    std::cout << "  --threads 1,2,4,8      thread counts (default: powers of two up to the core count), 1 always runs first" << std::endl;
+    std::cout << "  --mode single,batch,pipe" << std::endl;
+    std::cout << "  --batch-size n         names per parse_batch() call (default 256)" << std::endl;
+    std::cout << "  --shared-parser        all threads share one parser instance" << std::endl;
+    std::cout << "  --emit                 print the synthesized names and exit" << std::endl;
+}
+
+std::vector<std::string> split_list(const std::string &list) {
+    std::vector<std::string> values;
+    std::size_t start = 0;
+    std::size_t end;
+    while ((end = list.find(',', start)) != std::string::npos) {
+        values.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    values.push_back(list.substr(start));
+    return values;
+}
+
+/**
+ * Parses a whole argument as a number, unlike std::stoul which throws on garbage and ignores trailing characters
+ * @return if value was a valid number
+ */
+template<typename number_type>
+bool parse_number(const std::string &value, number_type &number) {
+    const char *last = value.data() + value.size();
+    auto [end, error] = std::from_chars(value.data(), last, number);
+    return error == std::errc() && end == last && !value.empty();
+}
+
+bool parse_mix(const std::string &list, std::vector<double> &mix) {
+    std::fill(mix.begin(), mix.end(), 0);
+    for (const auto &entry: split_list(list)) {
+        std::size_t separator = entry.find('=');
+        auto category = std::find(CATEGORY_NAMES.begin(), CATEGORY_NAMES.end(), entry.substr(0, separator));
+        if (separator == std::string::npos || category == CATEGORY_NAMES.end()) {
+            return false;
+        }
+        double weight;
+        if (!parse_number(entry.substr(separator + 1), weight) || weight < 0) {
+            return false;
+        }
+        mix[category - CATEGORY_NAMES.begin()] = weight;
+    }
+    return std::any_of(mix.begin(), mix.end(), [](double weight) { return weight > 0; });
+}
+
+/**
+ * Runs worker(thread_index) on the given number of threads and measures the wall time
+ */
+template<typename worker_type>
+double run_threads(std::size_t threads, worker_type worker) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back(worker, thread);
+    }
+    for (auto &thread: workers) {
+        thread.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+run_result run_single(const std::vector<std::string> &names, std::size_t threads, const load_options &options,
+                      const scene_name::scene_name_parser &shared_parser) {
+    run_result result;
+    result.threads = threads;
+    result.names = names.size();
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<std::size_t> next_name{0};
+    std::atomic<std::size_t> checksum{0};
+
+    result.seconds = run_threads(threads, [&](std::size_t thread) {
+        scene_name::scene_name_parser own_parser;
+        const scene_name::scene_name_parser &parser = options.shared_parser ? shared_parser : own_parser;
+        latencies[thread].reserve(names.size() / threads + 1);
+        std::size_t local_checksum = 0;
+        std::size_t index;
+        while ((index = next_name.fetch_add(1, std::memory_order_relaxed)) < names.size()) {
+            auto start = std::chrono::steady_clock::now();
+            auto parse_result = parser.parse(names[index]);
+            latencies[thread].push_back(elapsed_ns(start));
+            local_checksum += parse_result.first.has_value() ? parse_result.first->name.size() : 0;
+        }
+        checksum += local_checksum;
+    });
+
+    for (auto &thread_latencies: latencies) {
+        result.latencies_ns.insert(result.latencies_ns.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    return result;
+}
+
+run_result run_batch(const std::vector<std::string> &names, std::size_t threads, const load_options &options,
+                     const scene_name::scene_name_parser &shared_parser) {
+    run_result result;
+    result.threads = threads;
+    result.names = names.size();
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<std::size_t> next_batch{0};
+    std::atomic<std::size_t> checksum{0};
+    const std::size_t batches = (names.size() + options.batch_size - 1) / options.batch_size;
+
+    result.seconds = run_threads(threads, [&](std::size_t thread) {
+        scene_name::scene_name_parser own_parser;
+        const scene_name::scene_name_parser &parser = options.shared_parser ? shared_parser : own_parser;
+        std::size_t local_checksum = 0;
+        std::size_t batch;
+        while ((batch = next_batch.fetch_add(1, std::memory_order_relaxed)) < batches) {
+            auto first = names.begin() + static_cast<std::ptrdiff_t>(batch * options.batch_size);
+            auto last = names.begin() + static_cast<std::ptrdiff_t>(std::min(names.size(), (batch + 1) * options.batch_size));
+            std::vector<std::string> batch_names(first, last);
+
+            auto start = std::chrono::steady_clock::now();
+            auto parse_results = parser.parse_batch(batch_names);
+            latencies[thread].push_back(elapsed_ns(start));
+            for (auto &parse_result: parse_results) {
+                local_checksum += parse_result.first.has_value() ? parse_result.first->name.size() : 0;
+            }
+        }
+        checksum += local_checksum;
+    });
+
+    for (auto &thread_latencies: latencies) {
+        result.latencies_ns.insert(result.latencies_ns.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    return result;
+}
+
+#ifdef SCENE_NAME_PARSER_HAS_PIPE
+
+/**
+ * A name read from the pipe, with the time it was read for the latency
+ */
+struct piped_name {
+    std::string name;
+    std::chrono::steady_clock::time_point read_time;
+};
+
+/**
+ * Writes all of data into fd, retrying writes interrupted by a signal
+ * @return 0 on success, the errno of the failed write otherwise
+ */
+int write_all(int fd, const std::string &data) {
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        ssize_t written = write(fd, data.data() + pos, data.size() - pos);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        pos += static_cast<std::size_t>(written);
+    }
+    return 0;
+}
+
+/**
+ * Writes the names into an OS pipe from one thread, reads them back line by line on another and hands them
+ * to the workers through a bounded queue. Latency is measured from reading a line to having it parsed,
+ * so it includes the time spent queued. Throughput is based on the names the workers actually parsed.
+ * @return std::nullopt if the pipe couldn't be created
+ */
+std::optional<run_result> run_pipe(const std::vector<std::string> &names, std::size_t threads, const load_options &options,
+                    const scene_name::scene_name_parser &shared_parser) {
+    run_result result;
+    result.threads = threads;
+    std::vector<std::vector<double>> latencies(threads);
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        return std::nullopt;
+    }
+
+    const std::size_t max_queued = 4096;
+    std::mutex queue_mutex;
+    std::condition_variable queue_not_empty;
+    std::condition_variable queue_not_full;
+    std::deque<piped_name> queue;
+    bool reading_done = false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    int write_error = 0;
+    std::atomic<std::size_t> parsed_names{0};
+
+    std::thread writer([&]() {
+        std::string buffer;
+        for (const auto &name: names) {
+            buffer += name;
+            buffer += '\n';
+            if (buffer.size() >= 65536) {
+                write_error = write_all(pipe_fds[1], buffer);
+                buffer.clear();
+                if (write_error != 0) {
+                    break;
+                }
+            }
+        }
+        if (write_error == 0) {
+            write_error = write_all(pipe_fds[1], buffer);
+        }
+        close(pipe_fds[1]);
+    });
+
+    std::thread reader([&]() {
+        std::vector<char> buffer(65536);
+        std::string line;
+        ssize_t count;
+        while ((count = read(pipe_fds[0], buffer.data(), buffer.size())) > 0 || (count < 0 && errno == EINTR)) {
+            for (ssize_t i = 0; i < count; i++) {
+                if (buffer[i] != '\n') {
+                    line.push_back(buffer[i]);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_not_full.wait(lock, [&]() { return queue.size() < max_queued; });
+                queue.push_back({std::move(line), std::chrono::steady_clock::now()});
+                lock.unlock();
+                queue_not_empty.notify_one();
+                line.clear();
+            }
+        }
+        close(pipe_fds[0]);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            reading_done = true;
+        }
+        queue_not_empty.notify_all();
+    });
+
+    std::vector<std::thread> workers;
+    for (std::size_t thread = 0; thread < threads; thread++) {
+        workers.emplace_back([&, thread]() {
+            scene_name::scene_name_parser own_parser;
+            const scene_name::scene_name_parser &parser = options.shared_parser ? shared_parser : own_parser;
+            while (true) {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_not_empty.wait(lock, [&]() { return !queue.empty() || reading_done; });
+                if (queue.empty()) {
+                    break;
+                }
+                piped_name next = std::move(queue.front());
+                queue.pop_front();
+                lock.unlock();
+                queue_not_full.notify_one();
+
+                parser.parse(next.name);
+                latencies[thread].push_back(elapsed_ns(next.read_time));
+                parsed_names.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    writer.join();
+    reader.join();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.names = parsed_names.load();
+    if (write_error != 0) {
+        std::cout << "Writing to the pipe failed: " << std::strerror(write_error) << ", " << result.names << " of "
+                  << names.size() << " names parsed" << std::endl;
+    }
+
+    for (auto &thread_latencies: latencies) {
+        result.latencies_ns.insert(result.latencies_ns.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    return result;
+}
+
+#endif
+
+double percentile(const std::vector<double> &sorted_values, double fraction) {
+    if (sorted_values.empty()) {
+        return 0;
+    }
+    auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted_values.size()));
+    return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+void print_result(run_result &result, double single_thread_throughput) {
+    std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+    double throughput = (result.seconds > 0) ? static_cast<double>(result.names) / result.seconds : 0;
+    double speedup = (single_thread_throughput > 0) ? throughput / single_thread_throughput : 1;
+
+    std::cout << std::setw(8) << result.threads
+              << std::setw(14) << static_cast<std::size_t>(throughput)
+              << std::setw(10) << speedup
+              << std::setw(12) << speedup / static_cast<double>(result.threads)
+              << std::setw(10) << percentile(result.latencies_ns, 0.5) / 1000
+              << std::setw(10) << percentile(result.latencies_ns, 0.9) / 1000
+              << std::setw(10) << percentile(result.latencies_ns, 0.99) / 1000
+              << std::setw(10) << percentile(result.latencies_ns, 0.999) / 1000
+              << std::setw(12) << (result.latencies_ns.empty() ? 0 : result.latencies_ns.back() / 1000)
+              << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    load_options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--names" && has_value) {
+            if (!parse_number(argv[++i], options.names)) {
+                std::cout << "Invalid number of names " << argv[i] << std::endl;
+                print_help();
+                return 1;
+            }
+        } else if (arg == "--seed" && has_value) {
+            if (!parse_number(argv[++i], options.seed)) {
+                std::cout << "Invalid seed " << argv[i] << std::endl;
+                print_help();
+                return 1;
+            }
+        } else if (arg == "--mix" && has_value) {
+            if (!parse_mix(argv[++i], options.mix)) {
+                std::cout << "Invalid mix " << argv[i] << std::endl;
+                print_help();
+                return 1;
+            }
+        } else if (arg == "--threads" && has_value) {
+            options.threads.clear();
+            for (const auto &threads: split_list(argv[++i])) {
+                std::size_t thread_count;
+                if (!parse_number(threads, thread_count)) {
+                    std::cout << "Invalid thread count " << threads << std::endl;
+                    print_help();
+                    return 1;
+                }
+                options.threads.push_back(std::max<std::size_t>(1, thread_count));
+            }
+        } else if (arg == "--mode" && has_value) {
+            options.modes = split_list(argv[++i]);
+        } else if (arg == "--batch-size" && has_value) {
+            if (!parse_number(argv[++i], options.batch_size)) {
+                std::cout << "Invalid batch size " << argv[i] << std::endl;
+                print_help();
+                return 1;
+            }
+            options.batch_size = std::max<std::size_t>(1, options.batch_size);
+        } else if (arg == "--shared-parser") {
+            options.shared_parser = true;
+        } else if (arg == "--emit") {
+            options.emit = true;
+        } else {
+            print_help();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    release_name_generator generator(options.seed, options.mix);
+    std::vector<std::string> names;
+    names.reserve(options.names);
+    for (std::size_t i = 0; i < options.names; i++) {
+        names.push_back(generator.next());
+    }
+
+    if (options.emit) {
+        for (const auto &name: names) {
+            std::cout << name << '\n';
+        }
+        return 0;
+    }
+
+    if (options.threads.empty()) {
+        std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t threads = 1; threads < cores; threads *= 2) {
+            options.threads.push_back(threads);
+        }
+        options.threads.push_back(cores);
+    }
+    // speedup and efficiency are relative to a single thread, so every mode starts with a single threaded run
+    options.threads.erase(std::remove(options.threads.begin(), options.threads.end(), 1), options.threads.end());
+    options.threads.insert(options.threads.begin(), 1);
+
+    std::cout << "Names: " << names.size() << ", mix:";
+    for (std::size_t i = 0; i < CATEGORY_NAMES.size(); i++) {
+        std::cout << " " << CATEGORY_NAMES[i] << "=" << options.mix[i];
+    }
+    std::cout << ", " << (options.shared_parser ? "shared parser" : "parser per thread") << std::endl;
+
+    scene_name::scene_name_parser shared_parser;
+
+    for (const auto &mode: options.modes) {
+        std::cout << std::endl << "Mode: " << mode;
+        if (mode == "batch") {
+            std::cout << " (" << options.batch_size << " names per batch, latency per batch)";
+        }
+        std::cout << std::endl;
+        std::cout << std::setw(8) << "threads" << std::setw(14) << "names/s" << std::setw(10) << "speedup"
+                  << std::setw(12) << "efficiency" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+                  << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(12) << "max us"
+                  << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+
+        double single_thread_throughput = 0;
+        for (std::size_t threads: options.threads) {
+            run_result result;
+            if (mode == "single") {
+                result = run_single(names, threads, options, shared_parser);
+            } else if (mode == "batch") {
+                result = run_batch(names, threads, options, shared_parser);
+#ifdef SCENE_NAME_PARSER_HAS_PIPE
+            } else if (mode == "pipe") {
+                auto piped_result = run_pipe(names, threads, options, shared_parser);
+                if (!piped_result.has_value()) {
+                    std::cout << "Could not create a pipe, skipping mode " << mode << std::endl;
+                    break;
+                }
+                result = std::move(piped_result.value());
+#endif
+            } else {
+                std::cout << "Unknown or unsupported mode " << mode << std::endl;
+                break;
+            }
+
+            if (threads == 1 && result.seconds > 0) {
+                single_thread_throughput = static_cast<double>(result.names) / result.seconds;
+            }
+            print_result(result, single_thread_throughput);
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    return 0;
+}
@@ -23,11 +23,24 @@ int main(int argc, char *argv[]) {
                 std::cout << "Release year: " << parse_result.first->year.value() << std::endl;
             }
             if (parse_result.first->show_info.has_value()) {
-                if (parse_result.first->show_info->complete_season) {
-                    std::cout << "Complete season " << parse_result.first->show_info->season << std::endl;
+                if (parse_result.first->show_info->complete_series) {
+                    std::cout << "Complete series" << std::endl;
+                } else if (parse_result.first->show_info->complete_season) {
+                    if (parse_result.first->show_info->last_season != parse_result.first->show_info->season) {
+                        std::cout << "Complete seasons " << parse_result.first->show_info->season << " to "
+                                  << parse_result.first->show_info->last_season << std::endl;
+                    } else {
+                        std::cout << "Complete season " << parse_result.first->show_info->season << std::endl;
+                    }
                 } else {
-                    std::cout << "Season " << parse_result.first->show_info->season << ", Episode "
-                              << parse_result.first->show_info->episode << std::endl;
+                    std::cout << "Season " << parse_result.first->show_info->season << ", Episode";
+                    if (parse_result.first->show_info->episodes.size() > 1) {
+                        std::cout << "s";
+                    }
+                    for (auto &episode: parse_result.first->show_info->episodes) {
+                        std::cout << " " << episode;
+                    }
+                    std::cout << std::endl;
                 }
             }
             std::cout << "Release group: " << parse_result.first->group << std::endl;
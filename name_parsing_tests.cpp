@@ -2,19 +2,20 @@
 
 #include "extern/doctest/doctest/doctest.h"
 #include "scene-name-parser.hpp"
+#include "scene-name-columns.hpp"
+#include "scene-name-trace.hpp"
+
+#include <thread>
 
 
 
 const std::map<std::string, scene_release_info::release_info> test_matrix_shows {
-        /**
-         * this is an evil one, since the movie name contains a number which may collide with the release date
-         */
         {"Random.Show.Name.S03.Complete.German.DL.1080p.BluRay.x265-ReleaseGroup",
                 {"Random Show Name",
-                        2015,
-                        scene_release_info::scene_release_type::rt_movie,
+                        std::nullopt,
+                        scene_release_info::scene_release_type::rt_show,
                         scene_release_info::scene_edition_info::ei_none,
-                        scene_release_info::release_info_show{3, 0, true},
+                        scene_release_info::release_info_show{3, 0, true, 3, {}, false},
                         {
                                 scene_release_info::container_type::ct_h265,
                                 scene_release_info::resolution_info::ri_1080,
@@ -28,9 +29,105 @@ const std::map<std::string, scene_release_info::release_info> test_matrix_shows
         {"Random.Show.Episode.Name.S03E42.German.DL.1080p.BluRay.x265-ReleaseGroup",
          {"Random Show Episode Name",
           std::nullopt,
-          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{3, 42, false, 3, {42}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random.Show.Name.2019.S01E02.German.DL.1080p.BluRay.x265-ReleaseGroup",
+         {"Random Show Name",
+          2019,
+          scene_release_info::scene_release_type::rt_show,
           scene_release_info::scene_edition_info::ei_none,
-          scene_release_info::release_info_show{3, 42, false},
+          scene_release_info::release_info_show{1, 2, false, 1, {2}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random.Show.Name.S01E01E02.German.DL.1080p.BluRay.x265-ReleaseGroup",
+         {"Random Show Name",
+          std::nullopt,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{1, 1, false, 1, {1, 2}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random.Show.Name.S02E05-E08.German.DL.1080p.BluRay.x265-ReleaseGroup",
+         {"Random Show Name",
+          std::nullopt,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{2, 5, false, 2, {5, 6, 7, 8}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random Show Name 02x05-07 German DL 1080p BluRay x265-ReleaseGroup",
+         {"Random Show Name",
+          std::nullopt,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{2, 5, false, 2, {5, 6, 7}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random.Show.Name.S01-S03.German.DL.1080p.BluRay.x265-ReleaseGroup",
+         {"Random Show Name",
+          std::nullopt,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{1, 0, true, 3, {}, false},
+          {
+                  scene_release_info::container_type::ct_h265,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "german",
+                  {"DL"}
+          },
+          "ReleaseGroup"
+         }
+        },
+        {"Random.Show.Name.Complete.Series.German.DL.1080p.BluRay.x265-ReleaseGroup",
+         {"Random Show Name",
+          std::nullopt,
+          scene_release_info::scene_release_type::rt_show,
+          scene_release_info::scene_edition_info::ei_none,
+          scene_release_info::release_info_show{0, 0, false, 0, {}, true},
           {
                   scene_release_info::container_type::ct_h265,
                   scene_release_info::resolution_info::ri_1080,
@@ -128,6 +225,105 @@ const std::map<std::string, scene_release_info::release_info> test_matrix_movies
           "ReleaseGroup"
          }
         },
+        /**
+         * Titles that look like show markers, which must not be mistaken for one when guessing the type
+         */
+        {"10x10.2018.1080p.BluRay.x264-G",
+         {"10x10",
+          2018,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
+        {"S2.2004.1080p.BluRay.x264-G",
+         {"S2",
+          2004,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
+        {"Random.1x1.2010.1080p.BluRay.x264-G",
+         {"Random 1x1",
+          2010,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
+        {"The.Complete.Series.2010.1080p.BluRay.x264-G",
+         {"The Complete Series",
+          2010,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
+        {"Random.Show.S01.Complete.2010.1080p.BluRay.x264-G",
+         {"Random Show S01 Complete",
+          2010,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
+        {"Random.Show.S01.2010.1080p.BluRay.x264-G",
+         {"Random Show S01",
+          2010,
+          scene_release_info::scene_release_type::rt_movie,
+          scene_release_info::scene_edition_info::ei_none,
+          std::nullopt,
+          {
+                  scene_release_info::container_type::ct_h264,
+                  scene_release_info::resolution_info::ri_1080,
+                  scene_release_info::media_source::ms_bluray,
+                  "english",
+                  {}
+          },
+          "G"
+         }
+        },
         /**
          * Same as above, but with "DIRECTOR CUT", missing the "s"
          */
@@ -169,6 +365,14 @@ TEST_CASE("Scene name tests - movies"){
         CHECK_EQ(parsing_result.first->media_info.language, test_case.second.media_info.language);
         CHECK_EQ(parsing_result.first->media_info.resolution, test_case.second.media_info.resolution);
         CHECK_EQ(parsing_result.first->media_info.source, test_case.second.media_info.source);
+
+        // guessing the type must not turn any of these into a show
+        auto guessed_result = parser.parse(test_case.first);
+        CHECK_EQ(guessed_result.first->release_type, scene_release_info::scene_release_type::rt_unknown);
+        CHECK_EQ(guessed_result.first->name, test_case.second.name);
+        CHECK_EQ(guessed_result.first->year, test_case.second.year);
+        CHECK_EQ(guessed_result.first->show_info, std::nullopt);
+        CHECK_EQ(guessed_result.first->media_info.features, test_case.second.media_info.features);
     }
 }
 
@@ -186,6 +390,9 @@ TEST_CASE("Scene name tests - shows"){
         CHECK_EQ(parsing_result.first->show_info->episode, test_case.second.show_info->episode);
         CHECK_EQ(parsing_result.first->show_info->season, test_case.second.show_info->season);
         CHECK_EQ(parsing_result.first->show_info->complete_season, test_case.second.show_info->complete_season);
+        CHECK_EQ(parsing_result.first->show_info->last_season, test_case.second.show_info->last_season);
+        CHECK_EQ(parsing_result.first->show_info->episodes, test_case.second.show_info->episodes);
+        CHECK_EQ(parsing_result.first->show_info->complete_series, test_case.second.show_info->complete_series);
         CHECK_EQ(parsing_result.first->edition_info, test_case.second.edition_info);
         //media info tests
         CHECK_EQ(parsing_result.first->media_info.container, test_case.second.media_info.container);
@@ -194,4 +401,244 @@ TEST_CASE("Scene name tests - shows"){
         CHECK_EQ(parsing_result.first->media_info.resolution, test_case.second.media_info.resolution);
         CHECK_EQ(parsing_result.first->media_info.source, test_case.second.media_info.source);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Scene name tests - show detection"){
+
+    scene_name::scene_name_parser parser;
+
+    auto show = parser.parse("Random.Show.Name.S01E01E02.German.DL.1080p.BluRay.x265-ReleaseGroup");
+    CHECK_EQ(show.first->release_type, scene_release_info::scene_release_type::rt_show);
+    CHECK_EQ(show.first->show_info->episodes, (std::vector<uint16_t>{1, 2}));
+
+    // show markers are ignored if the user is sure it's a movie
+    auto movie = parser.parse("Random.Movie.Name.2015.S01E01.German.DL.1080p.BluRay.x265-ReleaseGroup",
+                              scene_release_info::scene_release_type::rt_movie);
+    CHECK_EQ(movie.first->release_type, scene_release_info::scene_release_type::rt_movie);
+    CHECK_EQ(movie.first->show_info, std::nullopt);
+
+    // things that look a bit like markers, but aren't
+    auto not_a_show = parser.parse("Random.Movie.Name.2015.German.DL.1080p.BluRay.x265-ReleaseGroup");
+    CHECK_EQ(not_a_show.first->release_type, scene_release_info::scene_release_type::rt_unknown);
+    CHECK_EQ(not_a_show.first->show_info, std::nullopt);
+}
+
+TEST_CASE("Scene name tests - batch"){
+
+    scene_name::scene_name_parser parser;
+
+    std::vector<std::string> batch;
+    for (auto &test_case: test_matrix_shows) {
+        if (test_case.first.find('.') != std::string::npos) {
+            batch.push_back(test_case.first);
+        }
+    }
+    // outliers, with another delimiter and group
+    batch.emplace_back("Random Movie Name 2022 DIRECTOR CUT German DD71 2160p DV DL HDR10 WebUHD x265-OtherGroup");
+    batch.emplace_back("Random.Movie.Name.2015.German.DL.1080p.BluRay.x265-Other-Group");
+    batch.emplace_back("");
+
+    auto layout = parser.learn_layout(batch);
+    CHECK_EQ(layout.delimiter, ".");
+    CHECK_EQ(layout.group, "ReleaseGroup");
+
+    // the batch has to come to the same conclusions as parsing each name on its own
+    auto results = parser.parse_batch(batch);
+    REQUIRE_EQ(results.size(), batch.size());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        auto single_result = parser.parse(batch[i]);
+        CHECK_EQ(results[i].second, single_result.second);
+        if (single_result.first.has_value()) {
+            CHECK_EQ(results[i].first->name, single_result.first->name);
+            CHECK_EQ(results[i].first->year, single_result.first->year);
+            CHECK_EQ(results[i].first->group, single_result.first->group);
+            CHECK_EQ(results[i].first->release_type, single_result.first->release_type);
+            CHECK_EQ(results[i].first->media_info.features, single_result.first->media_info.features);
+        }
+    }
+
+    // a season folder, where all names share the tail behind the show marker
+    std::vector<std::string> season;
+    for (int episode = 1; episode <= 12; episode++) {
+        season.push_back("Random.Show.Name.S01E" + std::to_string(episode) + ".German.DL.1080p.BluRay.x265-ReleaseGroup");
+    }
+    auto season_results = parser.parse_batch(season);
+    REQUIRE_EQ(season_results.size(), season.size());
+    for (std::size_t i = 0; i < season.size(); i++) {
+        REQUIRE(season_results[i].first.has_value());
+        CHECK_EQ(season_results[i].first->name, "Random Show Name");
+        CHECK_EQ(season_results[i].first->group, "ReleaseGroup");
+        CHECK_EQ(season_results[i].first->show_info->episode, i + 1);
+        CHECK_EQ(season_results[i].first->media_info.resolution, scene_release_info::resolution_info::ri_1080);
+        CHECK_EQ(season_results[i].first->media_info.features, std::set<std::string>{"DL"});
+    }
+
+    // names the parser used to throw on must not take the rest of the batch down with them
+    std::vector<std::string> broken_names{"Movie.2016.", "Movie..2016.1080p-G", "Movie.123456789012.1080p-G", "2016"};
+    std::vector<std::string> with_broken = season;
+    with_broken.insert(with_broken.begin() + 3, broken_names.begin(), broken_names.end());
+    auto with_broken_results = parser.parse_batch(with_broken);
+    REQUIRE_EQ(with_broken_results.size(), with_broken.size());
+    for (auto &parse_result: with_broken_results) {
+        CHECK_EQ(parse_result.second, scene_name::parsing_result::pr_success);
+    }
+    CHECK_EQ(with_broken_results[3].first->name, "Movie");
+    CHECK_EQ(with_broken_results[3].first->year, 2016);
+    CHECK_EQ(with_broken_results[5].first->year, std::nullopt);
+    CHECK_EQ(with_broken_results.back().first->show_info->episode, 12);
+
+    // no dominant layout in a mixed sample
+    auto mixed_layout = parser.learn_layout({"A.Movie.2015.1080p.x264-One", "A Movie 2015 1080p x264-Two"});
+    CHECK_EQ(mixed_layout.delimiter, "");
+    CHECK_EQ(mixed_layout.group, "");
+}
+
+TEST_CASE("Trace sink"){
+
+    scene_name::trace_ring ring(3);
+    CHECK_EQ(ring.capacity(), 4);
+
+    scene_name::scene_name_parser parser;
+    parser.set_trace_sink(&ring);
+    std::string release_name = "Random.Show.Name.S03E42.German.DL.1080p.BluRay.x265-ReleaseGroup";
+    parser.parse(release_name);
+
+    std::vector<scene_name::trace_event> events;
+    ring.drain([&](const scene_name::trace_event &event) {
+        events.push_back(event);
+    });
+#ifndef SCENE_NAME_PARSER_NO_TRACE
+    REQUIRE_EQ(events.size(), 2);
+    CHECK_EQ(events[0].type, scene_name::trace_event_type::te_delimiter_guessed);
+    CHECK_EQ(events[0].value, '.');
+    // truncated to fit the event
+    CHECK_EQ(std::string(events[0].text), release_name.substr(0, sizeof(events[0].text) - 1));
+    CHECK_EQ(events[1].type, scene_name::trace_event_type::te_show_found);
+    CHECK_EQ(events[1].value, 3);
+#else
+    // tracing is compiled out, the parser never reaches the sink
+    CHECK(events.empty());
+#endif
+
+    // a full buffer drops events instead of blocking
+    for (int i = 0; i < 6; i++) {
+        ring.trace(scene_name::trace_event(scene_name::trace_event_type::te_batch_outlier, "name", i));
+    }
+    CHECK_EQ(ring.dropped(), 2);
+    std::size_t drained_value = 0;
+    CHECK_EQ(ring.drain([&](const scene_name::trace_event &event) {
+        CHECK_EQ(event.value, drained_value++);
+    }), 4);
+
+    // multiple parsing threads writing while the host drains
+    scene_name::trace_ring shared_ring(64);
+    parser.set_trace_sink(&shared_ring);
+    std::atomic<bool> parsing_done = false;
+    std::size_t received = 0;
+    std::thread reader([&]() {
+        while (!parsing_done) {
+            received += shared_ring.drain([](const scene_name::trace_event &) {});
+        }
+        received += shared_ring.drain([](const scene_name::trace_event &) {});
+    });
+    std::vector<std::thread> writers;
+    for (int thread = 0; thread < 4; thread++) {
+        writers.emplace_back([&]() {
+            scene_name::scene_name_parser thread_parser;
+            thread_parser.set_trace_sink(&shared_ring);
+            for (int i = 0; i < 500; i++) {
+                thread_parser.parse("Random.Movie.Name.2015.German.DL.1080p.BluRay.x265-ReleaseGroup");
+            }
+        });
+    }
+    for (auto &writer: writers) {
+        writer.join();
+    }
+    parsing_done = true;
+    reader.join();
+#ifndef SCENE_NAME_PARSER_NO_TRACE
+    CHECK_EQ(received + shared_ring.dropped(), 4 * 500);
+#else
+    CHECK_EQ(received + shared_ring.dropped(), 0);
+#endif
+}
+
+TEST_CASE("Release columns"){
+
+    scene_name::scene_name_parser parser;
+    std::vector<std::string> batch{
+            "Random.Movie.Name.2021.2160p.WEB.DV.HDR10.x265-ReleaseGroup",
+            "Random.Movie.Name.2019.2160p.WEB.x265-ReleaseGroup",
+            "Random.Movie.Name.2022.1080p.WEB.x265-ReleaseGroup",
+            "Random.Movie.Name.2023.2160p.BluRay.x265-ReleaseGroup",
+            "Random.Movie.Name.2020.2160p.WEB.HDR10.x264-ReleaseGroup",
+            "Random.Show.Name.S01E01.2160p.WEB.DV.x265-ReleaseGroup",
+            ""
+    };
+
+    auto columns = scene_name::parse_batch_columns(parser, batch);
+    REQUIRE_EQ(columns.size(), batch.size());
+    CHECK_EQ(columns.year[0], 2021);
+    CHECK_EQ(columns.year[5], 0);
+    CHECK_EQ(columns.release_type[5], scene_release_info::scene_release_type::rt_show);
+    CHECK_EQ(columns.resolution[6], scene_release_info::resolution_info::ri_unknown);
+    CHECK_EQ(columns.features[0], scene_release_info::feature_bit("DV") | scene_release_info::feature_bit("hdr10"));
+    CHECK_EQ(scene_release_info::feature_bit("ReleaseGroup"), 0);
+
+    // 2160p HEVC WEB from 2020+
+    auto selection = scene_name::select_all(columns);
+    scene_name::filter_resolution(columns, scene_release_info::resolution_info::ri_2160, selection);
+    scene_name::filter_container(columns, scene_release_info::container_type::ct_h265, selection);
+    scene_name::filter_source(columns, scene_release_info::media_source::ms_web, selection);
+    scene_name::filter_year_at_least(columns, 2020, selection);
+    CHECK_EQ(scene_name::count_selected(selection), 1);
+    CHECK_EQ(scene_name::selected_rows(selection), std::vector<std::size_t>{0});
+
+    // shows have no year, but can still be selected by their features
+    selection = scene_name::select_all(columns);
+    scene_name::filter_features_all(columns, scene_release_info::feature_bit("DV"), selection);
+    CHECK_EQ(scene_name::count_selected(selection), 2);
+    scene_name::filter_release_type(columns, scene_release_info::scene_release_type::rt_show, selection);
+    CHECK_EQ(scene_name::selected_rows(selection), std::vector<std::size_t>{5});
+
+    selection = scene_name::select_all(columns);
+    scene_name::filter_year_between(columns, 2019, 2021, selection);
+    scene_name::filter_features_none(columns, scene_release_info::feature_bit("HDR10"), selection);
+    CHECK_EQ(scene_name::selected_rows(selection), std::vector<std::size_t>{1});
+}
+
+TEST_CASE("Scene name tests - normalization"){
+
+    scene_name::scene_name_parser parser;
+
+    // UTF-8 titles are kept as they are
+    auto utf8 = parser.parse("Amélie.Ça.Va.2001.FRENCH.1080p.BluRay.x264-ReleaseGroup");
+    REQUIRE_EQ(utf8.second, scene_name::parsing_result::pr_success);
+    CHECK_EQ(utf8.first->name, "Amélie Ça Va");
+    CHECK_EQ(utf8.first->year, 2001);
+    CHECK_EQ(utf8.first->media_info.container, scene_release_info::container_type::ct_h264);
+
+    // full-width delimiters, digits and letters are mapped to ASCII
+    auto full_width = parser.parse("Ｒａｎｄｏｍ．Ｍｏｖｉｅ．２０１５．ＧＥＲＭＡＮ．１０８０ｐ．ＢｌｕＲａｙ．ｘ２６５－ＲｅｌｅａｓｅＧｒｏｕｐ");
+    REQUIRE_EQ(full_width.second, scene_name::parsing_result::pr_success);
+    CHECK_EQ(full_width.first->name, "Random Movie");
+    CHECK_EQ(full_width.first->year, 2015);
+    CHECK_EQ(full_width.first->group, "ReleaseGroup");
+    CHECK_EQ(full_width.first->media_info.language, "german");
+    CHECK_EQ(full_width.first->media_info.resolution, scene_release_info::resolution_info::ri_1080);
+    CHECK_EQ(full_width.first->media_info.container, scene_release_info::container_type::ct_h265);
+
+    auto ideographic_space = parser.parse("東京　物語　1953　1080p　BluRay　x264-ReleaseGroup");
+    REQUIRE_EQ(ideographic_space.second, scene_name::parsing_result::pr_success);
+    CHECK_EQ(ideographic_space.first->name, "東京 物語");
+    CHECK_EQ(ideographic_space.first->year, 1953);
+
+    // invalid UTF-8: stray continuation byte, overlong encoding, surrogate, truncated sequence
+    for (const std::string &malformed: {std::string("Random.Movie\x80.2015.1080p-ReleaseGroup"),
+                                        std::string("Random.Movie\xC0\xAE.2015.1080p-ReleaseGroup"),
+                                        std::string("Random.Movie\xED\xA0\x80.2015.1080p-ReleaseGroup"),
+                                        std::string("Random.Movie.2015.1080p-ReleaseGroup\xE6\x9D")}) {
+        CHECK_EQ(parser.parse(malformed).second, scene_name::parsing_result::pr_malformed);
+        CHECK_EQ(parser.parse_batch({malformed}).front().second, scene_name::parsing_result::pr_malformed);
+    }
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "scene-name-parser.hpp"
+
+namespace scene_release_info {
+
+    /**
+     * Features that get a bit in release_columns::features. Matched ignoring case.
+     */
+    const std::array<std::string, 24> KNOWN_FEATURES{
+            "dl", "dv", "hdr", "hdr10", "hdr10plus", "atmos", "dts", "dd51", "dd71", "ddp5", "truehd", "aac",
+            "remux", "proper", "repack", "internal", "limited", "subbed", "dubbed", "multi", "amzn", "nf", "dsnp",
+            "10bit"
+    };
+
+    using feature_bits = uint64_t;
+
+    /**
+     * @return the bit of a known feature, 0 for unknown ones
+     */
+    inline feature_bits feature_bit(std::string_view feature) {
+        static_assert(KNOWN_FEATURES.size() <= sizeof(feature_bits) * 8);
+
+        for (std::size_t i = 0; i < KNOWN_FEATURES.size(); i++) {
+            const std::string &known_feature = KNOWN_FEATURES[i];
+            if (known_feature.size() != feature.size()) {
+                continue;
+            }
+            bool equal = true;
+            for (std::size_t c = 0; c < feature.size() && equal; c++) {
+                char lower = (feature[c] >= 'A' && feature[c] <= 'Z') ? static_cast<char>(feature[c] + ('a' - 'A')) : feature[c];
+                equal = (lower == known_feature[c]);
+            }
+            if (equal) {
+                return feature_bits{1} << i;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * Structure of arrays layout for the results of a batch, for filtering lots of releases quickly.
+     *
+     * Row i holds the release at index i of the batch. Releases that failed to parse have all columns
+     * unknown. Features outside KNOWN_FEATURES are left out, and so are the strings (name, group, language) -
+     * use the row index to get back to them.
+     */
+    struct release_columns {
+        std::vector<uint16_t> year; // 0 if unknown
+        std::vector<resolution_info> resolution;
+        std::vector<media_source> source;
+        std::vector<container_type> container;
+        std::vector<scene_edition_info> edition_info;
+        std::vector<scene_release_type> release_type;
+        std::vector<feature_bits> features;
+
+        std::size_t size() const {
+            return year.size();
+        }
+
+        void reserve(std::size_t rows) {
+            year.reserve(rows);
+            resolution.reserve(rows);
+            source.reserve(rows);
+            container.reserve(rows);
+            edition_info.reserve(rows);
+            release_type.reserve(rows);
+            features.reserve(rows);
+        }
+
+        void push_back(const release_info &ri) {
+            feature_bits bits = 0;
+            for (const auto &feature: ri.media_info.features) {
+                bits |= feature_bit(feature);
+            }
+
+            year.push_back(ri.year.value_or(0));
+            resolution.push_back(ri.media_info.resolution);
+            source.push_back(ri.media_info.source);
+            container.push_back(ri.media_info.container);
+            edition_info.push_back(ri.edition_info);
+            release_type.push_back(ri.release_type);
+            features.push_back(bits);
+        }
+
+        void push_back(const std::optional<release_info> &ri) {
+            if (ri.has_value()) {
+                push_back(ri.value());
+            } else {
+                push_back(release_info{});
+            }
+        }
+    };
+
+}
+
+namespace scene_name {
+
+    /**
+     * Rows of a release_columns a filter matched, one byte per row (1 = selected).
+     *
+     * The filters below narrow it down column by column. Each of them is a single branch free loop over
+     * contiguous arrays, which the compiler turns into SIMD code.
+     */
+    using release_selection = std::vector<uint8_t>;
+
+    /**
+     * Parses a batch (see scene_name_parser::parse_batch) into the structure of arrays layout.
+     */
+    inline scene_release_info::release_columns
+    parse_batch_columns(const scene_name_parser &parser, const std::vector<std::string> &release_names,
+                        scene_release_info::scene_release_type release_type = scene_release_info::scene_release_type::rt_unknown) {
+        scene_release_info::release_columns columns;
+        columns.reserve(release_names.size());
+        for (const auto &parse_result: parser.parse_batch(release_names, release_type)) {
+            columns.push_back(parse_result.first);
+        }
+        return columns;
+    }
+
+    inline release_selection select_all(const scene_release_info::release_columns &columns) {
+        return release_selection(columns.size(), 1);
+    }
+
+    namespace detail {
+        template<typename column_type, typename predicate_type>
+        inline void filter_column(const std::vector<column_type> &column, release_selection &selection,
+                                  predicate_type predicate) {
+            const column_type *values = column.data();
+            uint8_t *selected = selection.data();
+            const std::size_t rows = std::min(column.size(), selection.size());
+            for (std::size_t i = 0; i < rows; i++) {
+                selected[i] &= static_cast<uint8_t>(predicate(values[i]));
+            }
+        }
+    }
+
+    inline void filter_year_at_least(const scene_release_info::release_columns &columns, uint16_t min_year,
+                                     release_selection &selection) {
+        detail::filter_column(columns.year, selection, [min_year](uint16_t year) { return year >= min_year; });
+    }
+
+    /**
+     * Keeps releases with a year within [min_year, max_year]. Releases without a year never match.
+     */
+    inline void filter_year_between(const scene_release_info::release_columns &columns, uint16_t min_year,
+                                    uint16_t max_year, release_selection &selection) {
+        detail::filter_column(columns.year, selection, [min_year, max_year](uint16_t year) {
+            return (year >= min_year) & (year <= max_year);
+        });
+    }
+
+    inline void filter_resolution(const scene_release_info::release_columns &columns,
+                                  scene_release_info::resolution_info resolution, release_selection &selection) {
+        detail::filter_column(columns.resolution, selection, [resolution](scene_release_info::resolution_info value) {
+            return value == resolution;
+        });
+    }
+
+    inline void filter_source(const scene_release_info::release_columns &columns,
+                              scene_release_info::media_source source, release_selection &selection) {
+        detail::filter_column(columns.source, selection, [source](scene_release_info::media_source value) {
+            return value == source;
+        });
+    }
+
+    inline void filter_container(const scene_release_info::release_columns &columns,
+                                 scene_release_info::container_type container, release_selection &selection) {
+        detail::filter_column(columns.container, selection, [container](scene_release_info::container_type value) {
+            return value == container;
+        });
+    }
+
+    inline void filter_edition(const scene_release_info::release_columns &columns,
+                               scene_release_info::scene_edition_info edition_info, release_selection &selection) {
+        detail::filter_column(columns.edition_info, selection, [edition_info](scene_release_info::scene_edition_info value) {
+            return value == edition_info;
+        });
+    }
+
+    inline void filter_release_type(const scene_release_info::release_columns &columns,
+                                    scene_release_info::scene_release_type release_type, release_selection &selection) {
+        detail::filter_column(columns.release_type, selection, [release_type](scene_release_info::scene_release_type value) {
+            return value == release_type;
+        });
+    }
+
+    /**
+     * Keeps releases having all of the given features (see scene_release_info::feature_bit)
+     */
+    inline void filter_features_all(const scene_release_info::release_columns &columns,
+                                    scene_release_info::feature_bits features, release_selection &selection) {
+        detail::filter_column(columns.features, selection, [features](scene_release_info::feature_bits value) {
+            return (value & features) == features;
+        });
+    }
+
+    /**
+     * Keeps releases having none of the given features
+     */
+    inline void filter_features_none(const scene_release_info::release_columns &columns,
+                                     scene_release_info::feature_bits features, release_selection &selection) {
+        detail::filter_column(columns.features, selection, [features](scene_release_info::feature_bits value) {
+            return (value & features) == 0;
+        });
+    }
+
+    inline std::size_t count_selected(const release_selection &selection) {
+        std::size_t count = 0;
+        for (uint8_t selected: selection) {
+            count += selected;
+        }
+        return count;
+    }
+
+    /**
+     * @return the indices of the selected rows, which are also the indices within the parsed batch
+     */
+    inline std::vector<std::size_t> selected_rows(const release_selection &selection) {
+        std::vector<std::size_t> rows;
+        for (std::size_t i = 0; i < selection.size(); i++) {
+            if (selection[i]) {
+                rows.push_back(i);
+            }
+        }
+        return rows;
+    }
+
+}
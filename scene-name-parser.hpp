@@ -7,7 +7,15 @@
 #include <map>
 #include <set>
 #include <sstream>
-#include <regex>
+#include <cstdint>
+#include <string_view>
+#include <cstring>
+#include <array>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace scene_release_info {
 
@@ -16,7 +24,7 @@ namespace scene_release_info {
     };
 
 
-    enum class scene_release_type {
+    enum class scene_release_type : uint8_t {
         rt_unknown = 0,
         rt_movie = 1,
         rt_show = 2
@@ -25,20 +33,20 @@ namespace scene_release_info {
     /**
      * Container type of the release
      */
-    enum class container_type {
+    enum class container_type : uint8_t {
         ct_unknown = 0,
         ct_h264 = 1,
         ct_h265 = 2 //HVEC
     };
 
-    enum class resolution_info {
+    enum class resolution_info : uint8_t {
         ri_unknown = 0,
         ri_1080 = 1,
         ri_720 = 2,
         ri_2160 = 3 // UHD, 4K...
     };
 
-    enum class media_source {
+    enum class media_source : uint8_t {
         ms_unknown = 0,
         ms_bluray = 1,
         ms_web = 2,
@@ -46,7 +54,7 @@ namespace scene_release_info {
         ms_ts = 4 //might as well name this ms_trash
     };
 
-    enum class scene_edition_info {
+    enum class scene_edition_info : uint8_t {
         ei_none = 0,
         ei_extended = 1,
         ei_directors_cut = 2
@@ -60,10 +68,18 @@ namespace scene_release_info {
         std::set<std::string> features;
     };
 
+    /**
+     * Maximum number of episodes a range like S02E05-E08 may expand to
+     */
+    constexpr uint16_t MAX_EPISODE_RANGE = 500;
+
     struct release_info_show {
         uint16_t season = 0;
-        uint16_t episode = 0;
+        uint16_t episode = 0; // first episode, if the release contains multiple
         bool complete_season = false;
+        uint16_t last_season = 0; // last season of a multi season pack (S01-S03), same as season otherwise
+        std::vector<uint16_t> episodes; // all episodes of the release (S01E01E02, S02E05-E08)
+        bool complete_series = false;
     };
 
     struct release_info {
@@ -87,11 +103,94 @@ namespace scene_name {
         pr_no_delimiter
     };
 
+    /**
+     * Names of a batch sampled by scene_name_parser::learn_layout
+     */
+    constexpr std::size_t BATCH_LAYOUT_SAMPLE_SIZE = 32;
+
+    /**
+     * Layout shared by most names of a batch, like a folder of releases from the same group.
+     *
+     * Learned from a sample of the batch, see scene_name_parser::learn_layout.
+     */
+    struct batch_layout {
+        std::string delimiter; // empty if the sample has no dominant delimiter
+        std::string group; // empty if the sample has no dominant group
+    };
+
+    enum class trace_event_type : uint8_t {
+        te_delimiter_guessed = 0, // value: the delimiter character
+        te_show_found = 1, // value: the season
+        te_no_title = 2, // neither a year nor a show marker delimits the title
+        te_batch_layout_learned = 3, // text: the group, value: the delimiter character (0 if none)
+        te_batch_outlier = 4, // name didn't follow the batch layout
+        te_malformed = 5 // name isn't valid UTF-8
+    };
+
+    /**
+     * A single trace event, a fixed size so it can be copied around without allocating.
+     */
+    struct trace_event {
+        trace_event_type type = trace_event_type::te_delimiter_guessed;
+        uint32_t value = 0;
+        char text[56] = {}; // release name or detail, truncated and zero terminated
+
+        trace_event() = default;
+
+        trace_event(trace_event_type event_type, std::string_view event_text, uint32_t event_value = 0) {
+            type = event_type;
+            value = event_value;
+            std::size_t length = std::min(event_text.size(), sizeof(text) - 1);
+            std::copy_n(event_text.begin(), length, text);
+            text[length] = '\0';
+        }
+    };
+
+    /**
+     * Receives trace events from the parser. Called from whatever thread is parsing,
+     * so implementations must be thread safe and shouldn't block.
+     */
+    class trace_sink {
+    public:
+        virtual ~trace_sink() = default;
+
+        virtual void trace(const trace_event &event) noexcept = 0;
+    };
+
+    /**
+     * Parsing doesn't modify the parser, so a single instance can be shared between threads
+     * (as long as set_trace_sink isn't called meanwhile).
+     */
     class scene_name_parser {
     private:
         std::string _delimiter; //no delimiter means we guess from the passed name
-        std::regex _season_regex;
-        std::regex _episode_regex;
+        trace_sink *_trace_sink = nullptr;
+
+        /**
+         * Results of parsing the tail of a release name, everything behind the title
+         */
+        struct tail_info {
+            std::string group;
+            scene_release_info::scene_edition_info edition_info;
+            scene_release_info::release_media_info media_info;
+            std::optional<scene_release_info::release_info_show> show_info;
+        };
+
+        /**
+         * Parsed tails of a batch, indexed by whether the title already ended with a show marker.
+         *
+         * Batches without shared tails would only pay for the bookkeeping, so the cache gives up once
+         * most lookups miss.
+         */
+        struct tail_cache {
+            std::array<std::map<std::string, tail_info, std::less<>>, 2> tails;
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+
+            bool enabled() const {
+                return misses < 32 || hits * 4 >= misses;
+            }
+        };
 
         // stole from https://stackoverflow.com/questions/14265581/parse-split-a-string-in-c-using-string-delimiter-standard-c/46931770#46931770
         // because I am a lazy bugger
@@ -145,23 +244,212 @@ namespace scene_name {
             return delimiter_stats.front().first;
         }
 
+        /**
+         * Single pass version of guess_delimiter, used for names of a batch with a known layout.
+         *
+         * @return if delimiter occurs more often than every other allowed delimiter. Ties are left to
+         * guess_delimiter.
+         */
+        static bool has_dominant_delimiter(const std::string &release_name, const std::string &delimiter) {
+            std::array<std::size_t, scene_release_info::ALLOWED_DELIMITERS.size()> counts{};
+            for (char c: release_name) {
+                for (std::size_t i = 0; i < scene_release_info::ALLOWED_DELIMITERS.size(); i++) {
+                    counts[i] += (c == scene_release_info::ALLOWED_DELIMITERS[i].front());
+                }
+            }
+
+            std::size_t delimiter_count = 0;
+            std::size_t other_count = 0;
+            for (std::size_t i = 0; i < scene_release_info::ALLOWED_DELIMITERS.size(); i++) {
+                if (scene_release_info::ALLOWED_DELIMITERS[i] == delimiter) {
+                    delimiter_count = counts[i];
+                } else {
+                    other_count = std::max(other_count, counts[i]);
+                }
+            }
+            return delimiter_count > other_count;
+        }
+
+        /**
+         * The group of a release name, which is whatever follows the last minus, if it doesn't contain the delimiter.
+         * @return the group, or an empty string if there is none
+         */
+        static std::string guess_group(const std::string &release_name, const std::string &delimiter) {
+            std::size_t group_pos = release_name.rfind('-');
+            if (group_pos == std::string::npos || release_name.find(delimiter, group_pos) != std::string::npos) {
+                return "";
+            }
+            return release_name.substr(group_pos + 1);
+        }
+
+        /**
+         * Checks if the last part of a release name is "<something>-group", with a single minus.
+         */
+        static bool ends_with_group(const std::string &last_part, const std::string &group) {
+            if (group.empty() || last_part.size() <= group.size() + 1 || !last_part.ends_with(group)) {
+                return false;
+            }
+            std::size_t group_pos = last_part.size() - group.size() - 1;
+            return last_part.find('-') == group_pos;
+        }
+
+        /**
+         * Picks the value most of the sample agrees on.
+         * @return the value, or an empty string if it isn't shared by more than 3/4 of the sample
+         */
+        static std::string dominant_value(const std::vector<std::string> &values) {
+            std::map<std::string, std::size_t> occurences;
+            for (const auto &value: values) {
+                occurences[value]++;
+            }
+            auto dominant = std::max_element(occurences.begin(), occurences.end(), [](const auto &a, const auto &b) {
+                return a.second < b.second;
+            });
+            if (dominant == occurences.end() || dominant->second * 4 <= values.size() * 3) {
+                return "";
+            }
+            return dominant->first;
+        }
+
         /**
          * Checks if a string consists of 0123456789
-         * Ignores
+         * Ignores the locale, and any non ASCII byte is a non digit.
          * @param str the string to test
          * @return if a string only consists of the mentioned characters
          */
         static bool is_numeric(const std::string &str) {
             return std::find_if(str.begin(), str.end(), [](char c) {
-                return !std::isdigit(c);
+                return c < '0' || c > '9';
             }) == str.end();
         }
 
+        /**
+         * Checks if a part of the release name is a number that could be a year: 1 to 4 digits.
+         * Empty parts (from doubled delimiters) and longer numbers are treated like words of the title.
+         */
+        static bool is_number_part(const std::string &str) {
+            return !str.empty() && str.size() <= 4 && is_numeric(str);
+        }
+
+        /**
+         * Lowercases A-Z only. All keywords we match against are ASCII, and non ASCII bytes of UTF-8 titles
+         * are left alone instead of being mangled by the locale.
+         */
         static std::string to_lowercase(std::string str) {
-            std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+            std::transform(str.begin(), str.end(), str.begin(), [](char c) {
+                return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+            });
             return str;
         }
 
+        /**
+         * Checks if a string is plain ASCII, 16 (SSE2) or 8 bytes at a time.
+         */
+        static bool is_ascii(const std::string &str) {
+            const char *data = str.data();
+            const std::size_t size = str.size();
+            std::size_t pos = 0;
+#if defined(__SSE2__)
+            for (; pos + 16 <= size; pos += 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                if (_mm_movemask_epi8(chunk) != 0) {
+                    return false;
+                }
+            }
+#endif
+            for (; pos + 8 <= size; pos += 8) {
+                uint64_t chunk;
+                std::memcpy(&chunk, data + pos, sizeof(chunk));
+                if ((chunk & 0x8080808080808080ULL) != 0) {
+                    return false;
+                }
+            }
+            for (; pos < size; pos++) {
+                if ((static_cast<unsigned char>(data[pos]) & 0x80) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Normalization stage, ahead of splitting the release name into parts.
+         *
+         * Plain ASCII names (by far the most) are passed through as they are. Everything else has to be valid UTF-8,
+         * and gets its full-width forms (U+FF01 to U+FF5E, like "２０１５" or "．") and the ideographic space
+         * mapped to ASCII, so delimiters, digits and keywords are recognized. Other characters are kept.
+         *
+         * @param release_name the release name
+         * @param buffer storage for the normalized name, if one is needed
+         * @return the name to parse, which is either release_name or buffer. nullptr if release_name isn't valid UTF-8.
+         */
+        static const std::string *normalize(const std::string &release_name, std::string &buffer) {
+            if (is_ascii(release_name)) {
+                return &release_name;
+            }
+
+            buffer.clear();
+            buffer.reserve(release_name.size());
+            const std::size_t size = release_name.size();
+            std::size_t pos = 0;
+            while (pos < size) {
+                auto lead = static_cast<unsigned char>(release_name[pos]);
+                if (lead < 0x80) {
+                    buffer.push_back(static_cast<char>(lead));
+                    pos++;
+                    continue;
+                }
+
+                std::size_t length;
+                uint32_t code_point;
+                uint32_t min_code_point;
+                if (lead >= 0xC2 && lead <= 0xDF) {
+                    length = 2;
+                    code_point = lead & 0x1F;
+                    min_code_point = 0x80;
+                } else if (lead >= 0xE0 && lead <= 0xEF) {
+                    length = 3;
+                    code_point = lead & 0x0F;
+                    min_code_point = 0x800;
+                } else if (lead >= 0xF0 && lead <= 0xF4) {
+                    length = 4;
+                    code_point = lead & 0x07;
+                    min_code_point = 0x10000;
+                } else {
+                    return nullptr;
+                }
+
+                if (pos + length > size) {
+                    return nullptr;
+                }
+                for (std::size_t i = 1; i < length; i++) {
+                    auto continuation = static_cast<unsigned char>(release_name[pos + i]);
+                    if ((continuation & 0xC0) != 0x80) {
+                        return nullptr;
+                    }
+                    code_point = (code_point << 6) | (continuation & 0x3F);
+                }
+
+                // overlong encodings, surrogates and everything beyond unicode
+                if (code_point < min_code_point || (code_point >= 0xD800 && code_point <= 0xDFFF) ||
+                    code_point > 0x10FFFF) {
+                    return nullptr;
+                }
+
+                if (code_point >= 0xFF01 && code_point <= 0xFF5E) {
+                    // full-width ASCII
+                    buffer.push_back(static_cast<char>(code_point - 0xFEE0));
+                } else if (code_point == 0x3000) {
+                    // ideographic space
+                    buffer.push_back(' ');
+                } else {
+                    buffer.append(release_name, pos, length);
+                }
+                pos += length;
+            }
+            return &buffer;
+        }
+
         /**
          * checks if a given feature exists within the string of release name parts.
          * Ignores case.
@@ -198,17 +486,22 @@ namespace scene_name {
             return false;
         }
 
+        // isspace without the locale, which could take bytes of UTF-8 characters for spaces
+        static inline bool is_ascii_space(unsigned char ch) {
+            return ch == ' ' || (ch >= '\t' && ch <= '\r');
+        }
+
         // trim from start (in place)
         static inline void ltrim(std::string &s) {
             s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
-                return !std::isspace(ch);
+                return !is_ascii_space(ch);
             }));
         }
 
         // trim from end (in place)
         static inline void rtrim(std::string &s) {
             s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
-                return !std::isspace(ch);
+                return !is_ascii_space(ch);
             }).base(), s.end());
         }
 
@@ -218,29 +511,354 @@ namespace scene_name {
             ltrim(s);
         }
 
+        /**
+         * Reads up to max_digits decimal digits, starting at pos.
+         * @param pos position to start reading at, points behind the number afterwards
+         * @return if at least one digit was read
+         */
+        static bool read_number(const std::string &str, std::size_t &pos, std::size_t max_digits, uint16_t &number) {
+            std::size_t start = pos;
+            uint32_t value = 0;
+            while (pos < str.size() && pos - start < max_digits && str[pos] >= '0' && str[pos] <= '9') {
+                value = value * 10 + (str[pos] - '0');
+                pos++;
+            }
+            number = static_cast<uint16_t>(value);
+            return pos > start;
+        }
+
+        /**
+         * Passes an event to the trace sink, if there is one. Compiled out with SCENE_NAME_PARSER_NO_TRACE.
+         */
+        inline void trace([[maybe_unused]] trace_event_type type, [[maybe_unused]] std::string_view text,
+                          [[maybe_unused]] uint32_t value = 0) const {
+#ifndef SCENE_NAME_PARSER_NO_TRACE
+            if (_trace_sink != nullptr) {
+                _trace_sink->trace(trace_event(type, text, value));
+            }
+#endif
+        }
+
+        static scene_release_info::scene_release_type resolve_release_type(const scene_release_info::release_info &ri,
+                                                                           scene_release_info::scene_release_type release_type) {
+            if (release_type == scene_release_info::scene_release_type::rt_unknown && ri.show_info.has_value()) {
+                // user wanted us to guess the release type
+                return scene_release_info::scene_release_type::rt_show;
+            }
+            return release_type;
+        }
+
+        /**
+         * Checks if the character at pos is the given lowercase letter, ignoring case
+         */
+        static bool is_letter_at(const std::string &str, std::size_t pos, char lower_letter) {
+            return pos < str.size() && (str[pos] | 0x20) == lower_letter;
+        }
+
+        static bool equals_ignore_case(const std::string &str, const std::string &lower_str) {
+            if (str.size() != lower_str.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < str.size(); i++) {
+                if ((str[i] | 0x20) != lower_str[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Parses a single season/episode marker, in one go over the characters:
+         *
+         * S03 - complete season
+         * S01-S03, S01-03 - multiple complete seasons
+         * S03E42 - single episode
+         * S01E01E02, S02E05-E08, S02E05-08 - multiple episodes
+         * 03x42, 03x42x43, 03x42-44 - the same, in the rarer notation
+         *
+         * @param part a single part of the release name
+         * @param show filled with the season and episodes, if the part is a marker
+         * @param within_title the part could still belong to the title. Titles like "10x10" or "1x1" exist, so the
+         * rarer notation is only accepted with two digit season and episode then.
+         * @return if the part is a season/episode marker
+         */
+        static bool parse_show_marker(const std::string &part, scene_release_info::release_info_show &show,
+                                      bool within_title) {
+            scene_release_info::release_info_show parsed;
+            std::size_t pos = 0;
+
+            if (is_letter_at(part, 0, 's')) {
+                pos = 1;
+                if (!read_number(part, pos, 4, parsed.season)) {
+                    return false;
+                }
+                parsed.last_season = parsed.season;
+
+                if (pos == part.size()) {
+                    parsed.complete_season = true;
+                    show = parsed;
+                    return true;
+                }
+
+                if (part[pos] == '-') {
+                    pos++;
+                    if (is_letter_at(part, pos, 's')) {
+                        pos++;
+                    }
+                    if (!read_number(part, pos, 4, parsed.last_season) || pos != part.size() ||
+                        parsed.last_season < parsed.season) {
+                        return false;
+                    }
+                    parsed.complete_season = true;
+                    show = parsed;
+                    return true;
+                }
+
+                if (!is_letter_at(part, pos, 'e')) {
+                    return false;
+                }
+            } else {
+                if (!read_number(part, pos, 2, parsed.season) || !is_letter_at(part, pos, 'x')) {
+                    return false;
+                }
+                if (within_title && (pos != 2 || part.size() < 5 || part[3] < '0' || part[3] > '9' ||
+                                     part[4] < '0' || part[4] > '9')) {
+                    return false;
+                }
+                parsed.last_season = parsed.season;
+            }
+
+            // the episode list, each entry either prefixed by the episode letter or a dash for ranges
+            const char episode_letter = static_cast<char>(part[pos] | 0x20);
+            uint16_t previous_episode = 0;
+            while (pos < part.size()) {
+                bool is_range = false;
+                if (part[pos] == '-') {
+                    is_range = true;
+                    pos++;
+                    if (is_letter_at(part, pos, episode_letter)) {
+                        pos++;
+                    }
+                } else if (is_letter_at(part, pos, episode_letter)) {
+                    pos++;
+                } else {
+                    return false;
+                }
+
+                uint16_t episode;
+                if (!read_number(part, pos, 4, episode)) {
+                    return false;
+                }
+
+                if (is_range) {
+                    if (episode <= previous_episode || episode - previous_episode > scene_release_info::MAX_EPISODE_RANGE) {
+                        return false;
+                    }
+                    for (uint16_t range_episode = previous_episode + 1; range_episode <= episode; range_episode++) {
+                        parsed.episodes.push_back(range_episode);
+                    }
+                } else {
+                    parsed.episodes.push_back(episode);
+                }
+                previous_episode = episode;
+            }
+
+            parsed.episode = parsed.episodes.front();
+            show = parsed;
+            return true;
+        }
+
+        /**
+         * Checks if the part at index is a release year, which is a number not followed by another number
+         * (see the title extraction in parse_with_layout).
+         */
+        static bool is_year_at(const std::vector<std::string> &release_name_parts, std::size_t index) {
+            if (!is_number_part(release_name_parts[index])) {
+                return false;
+            }
+            return index + 1 >= release_name_parts.size() || !is_number_part(release_name_parts[index + 1]);
+        }
+
+        /**
+         * Checks if the release name parts contain show information at the given index. Besides the markers
+         * handled by parse_show_marker, this also handles multiple parts like "S03 Complete" and "Complete Series".
+         *
+         * Parts followed by the release year are part of the title (S2.2004, Random.1x1.2010, The.Complete.Series.2010),
+         * never a marker.
+         *
+         * @param show filled with the show information, if found
+         * @param within_title see parse_show_marker
+         * @return the number of parts the show information consists of, 0 if there is none at index
+         */
+        static std::size_t match_show_parts(const std::vector<std::string> &release_name_parts, std::size_t index,
+                                            scene_release_info::release_info_show &show, bool within_title) {
+            scene_release_info::release_info_show matched_show;
+            std::size_t show_parts = match_show_marker_parts(release_name_parts, index, matched_show, within_title);
+            if (show_parts == 0) {
+                return 0;
+            }
+            if (index + show_parts < release_name_parts.size() && is_year_at(release_name_parts, index + show_parts)) {
+                return 0;
+            }
+            show = matched_show;
+            return show_parts;
+        }
+
+        /**
+         * match_show_parts, without looking at what follows the show information
+         */
+        static std::size_t match_show_marker_parts(const std::vector<std::string> &release_name_parts, std::size_t index,
+                                                   scene_release_info::release_info_show &show, bool within_title) {
+            const std::string &part = release_name_parts[index];
+            bool has_next = index + 1 < release_name_parts.size();
+
+            if (parse_show_marker(part, show, within_title)) {
+                if (show.complete_season && has_next && equals_ignore_case(release_name_parts[index + 1], "complete")) {
+                    return 2;
+                }
+                return 1;
+            }
+
+            if (has_next && equals_ignore_case(part, "complete") &&
+                equals_ignore_case(release_name_parts[index + 1], "series")) {
+                show = {};
+                show.complete_series = true;
+                return 2;
+            }
+
+            return 0;
+        }
+
 
 
     public:
         explicit scene_name_parser(std::string delimiter = "") {
             _delimiter = std::move(delimiter);
-            _season_regex = std::regex("^[Ss]([0-9]{1,2})");
-            _episode_regex = std::regex("[Ee]([0-9]{1,2})$");
         }
 
-        inline std::pair<std::optional<scene_release_info::release_info>, parsing_result>
-        parse(const std::string &release_name, scene_release_info::scene_release_type release_type = scene_release_info::scene_release_type::rt_unknown) {
+        /**
+         * Sets the sink the parser reports what it detects to, for debugging. The parser never writes to the
+         * console itself.
+         * @param sink the sink, which has to outlive the parser. nullptr disables tracing.
+         */
+        void set_trace_sink(trace_sink *sink) {
+            _trace_sink = sink;
+        }
 
-            scene_release_info::release_info ri;
+        inline std::pair<std::optional<scene_release_info::release_info>, parsing_result>
+        parse(const std::string &raw_release_name, scene_release_info::scene_release_type release_type = scene_release_info::scene_release_type::rt_unknown) const {
 
-            if (release_name.empty()) {
+            if (raw_release_name.empty()) {
                 return {std::nullopt, parsing_result::pr_empty_name};
             }
 
+            std::string normalized_name;
+            const std::string *normalized = normalize(raw_release_name, normalized_name);
+            if (normalized == nullptr) {
+                trace(trace_event_type::te_malformed, raw_release_name);
+                return {std::nullopt, parsing_result::pr_malformed};
+            }
+            const std::string &release_name = *normalized;
+
             std::string local_delimiter;
 
-            local_delimiter = (_delimiter.empty() ? guess_delimiter(release_name) : _delimiter);
+            if (_delimiter.empty()) {
+                local_delimiter = guess_delimiter(release_name);
+                trace(trace_event_type::te_delimiter_guessed, release_name, static_cast<uint8_t>(local_delimiter.front()));
+            } else {
+                local_delimiter = _delimiter;
+            }
+
+            return parse_with_layout(release_name, local_delimiter, "", release_type);
+        }
+
+        /**
+         * Learns the delimiter and group most names of a batch share, from an evenly spaced sample of it.
+         * @param release_names the batch
+         * @param sample_size number of names to look at
+         * @return the layout, with empty fields for whatever the sample doesn't agree on
+         */
+        batch_layout learn_layout(const std::vector<std::string> &release_names,
+                                  std::size_t sample_size = BATCH_LAYOUT_SAMPLE_SIZE) const {
+            batch_layout layout;
+            sample_size = std::min(sample_size, release_names.size());
+            if (sample_size == 0) {
+                return layout;
+            }
+
+            std::vector<std::string> sample_delimiters;
+            std::vector<std::string> sample_groups;
+            sample_delimiters.reserve(sample_size);
+            sample_groups.reserve(sample_size);
+            for (std::size_t i = 0; i < sample_size; i++) {
+                std::string normalized_name;
+                const std::string *release_name = normalize(release_names[i * release_names.size() / sample_size],
+                                                            normalized_name);
+                if (release_name == nullptr || release_name->empty()) {
+                    continue;
+                }
+                sample_delimiters.push_back(_delimiter.empty() ? guess_delimiter(*release_name) : _delimiter);
+                sample_groups.push_back(guess_group(*release_name, sample_delimiters.back()));
+            }
+
+            layout.delimiter = dominant_value(sample_delimiters);
+            layout.group = dominant_value(sample_groups);
+            trace(trace_event_type::te_batch_layout_learned, layout.group,
+                  layout.delimiter.empty() ? 0 : static_cast<uint8_t>(layout.delimiter.front()));
+            return layout;
+        }
+
+        /**
+         * Parses a batch of release names, like the contents of a folder.
+         *
+         * Names following the layout of the batch skip the delimiter detection and the group split, and names
+         * sharing everything behind the title with an earlier name of the batch skip the feature detection.
+         * Only outliers go through the full detection of parse().
+         */
+        inline std::vector<std::pair<std::optional<scene_release_info::release_info>, parsing_result>>
+        parse_batch(const std::vector<std::string> &release_names, const batch_layout &layout,
+                    scene_release_info::scene_release_type release_type = scene_release_info::scene_release_type::rt_unknown) const {
+            std::vector<std::pair<std::optional<scene_release_info::release_info>, parsing_result>> results;
+            results.reserve(release_names.size());
+            tail_cache batch_tails;
+
+            std::string normalized_name;
+            for (const auto &raw_release_name: release_names) {
+                const std::string *release_name = normalize(raw_release_name, normalized_name);
+                bool follows_layout = release_name != nullptr && !release_name->empty() && !layout.delimiter.empty();
+                if (follows_layout &&
+                    (!_delimiter.empty() || has_dominant_delimiter(*release_name, layout.delimiter))) {
+                    results.push_back(parse_with_layout(*release_name, layout.delimiter, layout.group, release_type,
+                                                        &batch_tails));
+                } else {
+                    if (follows_layout) {
+                        trace(trace_event_type::te_batch_outlier, *release_name);
+                    }
+                    // empty and malformed names end up here as well, parse() reports them
+                    results.push_back(parse(raw_release_name, release_type));
+                }
+            }
+            return results;
+        }
+
+        inline std::vector<std::pair<std::optional<scene_release_info::release_info>, parsing_result>>
+        parse_batch(const std::vector<std::string> &release_names,
+                    scene_release_info::scene_release_type release_type = scene_release_info::scene_release_type::rt_unknown) const {
+            return parse_batch(release_names, learn_layout(release_names), release_type);
+        }
 
-            std::cout << local_delimiter;
+    private:
+        /**
+         * Parses a release name with a known delimiter.
+         * @param group_hint group the name probably ends with, empty if unknown
+         * @param batch_tails tails parsed earlier within the same batch, if any
+         */
+        inline std::pair<std::optional<scene_release_info::release_info>, parsing_result>
+        parse_with_layout(const std::string &release_name, const std::string &local_delimiter,
+                          const std::string &group_hint, scene_release_info::scene_release_type release_type,
+                          tail_cache *batch_tails = nullptr) const {
+
+            scene_release_info::release_info ri;
 
             //split up the release name by the delimiter
 
@@ -260,10 +878,38 @@ namespace scene_name {
              * this:
              *
              * Random.Movie.Name.German.DL.1080p.BluRay.x265-ReleaseGroup
+             *
+             * Everything behind the title is the tail of the release name, and tail_offset its position.
              */
 
+            std::size_t tail_offset = 0;
             while (!release_name_parts.empty()) {
-                if (!is_numeric(release_name_parts.front())) {
+                if (release_type != scene_release_info::scene_release_type::rt_movie && !ri.name.empty()) {
+                    /*
+                     * Shows often don't have a year, but a season/episode marker right behind the title:
+                     *
+                     * Random.Show.Name.S01E02.German.DL.1080p.BluRay.x265-ReleaseGroup
+                     *
+                     * The marker ends the title in this case. The title needs at least one word though, so
+                     * movies named like a marker (10x10.2018) keep their name.
+                     */
+                    scene_release_info::release_info_show show;
+                    std::size_t show_parts = match_show_parts(release_name_parts, 0, show, true);
+                    if (show_parts > 0) {
+                        ri.show_info = show;
+                        trace(trace_event_type::te_show_found, release_name, show.season);
+                        ri.year.reset();
+                        for (std::size_t i = 0; i < show_parts; i++) {
+                            tail_offset += release_name_parts[i].size() + local_delimiter.size();
+                        }
+                        release_name_parts.erase(release_name_parts.begin(), release_name_parts.begin() + show_parts);
+                        break;
+                    }
+                }
+
+                tail_offset += release_name_parts.front().size() + local_delimiter.size();
+
+                if (!is_number_part(release_name_parts.front())) {
                     ri.name += release_name_parts.front() + " ";
                     release_name_parts.erase(release_name_parts.begin());
                 } else {
@@ -272,7 +918,7 @@ namespace scene_name {
                      * We check if the next value is also a number (see above).
                      */
 
-                    if (release_name_parts.size() >= 2 && is_numeric(*(release_name_parts.begin() + 1))) {
+                    if (release_name_parts.size() >= 2 && is_number_part(*(release_name_parts.begin() + 1))) {
                         //yes, next part is also a number - this number is a part of the title.
                         ri.name += release_name_parts.front();
                         release_name_parts.erase(release_name_parts.begin());
@@ -299,7 +945,10 @@ namespace scene_name {
              * this will most likely be less than perfect, though.
              */
 
+            bool title_found = true;
             if (ri.name.size() == release_name.size()) {
+                title_found = false;
+                trace(trace_event_type::te_no_title, release_name);
                 // split the parts again
                 release_name_parts = split(release_name, local_delimiter);
                 // set the year to unknown
@@ -308,20 +957,53 @@ namespace scene_name {
                 ri.name.clear();
             }
 
+            /*
+             * Within a batch, releases of the same group mostly share everything behind the title, like
+             * "German.DL.1080p.BluRay.x265-ReleaseGroup". If we already parsed the same tail, we reuse its results.
+             */
+            std::map<std::string, tail_info, std::less<>> *tails = nullptr;
+            std::string_view tail;
+            if (batch_tails != nullptr && batch_tails->enabled() && title_found && tail_offset < release_name.size()) {
+                tails = &batch_tails->tails[ri.show_info.has_value() ? 1 : 0];
+                tail = std::string_view(release_name).substr(tail_offset);
+                auto cached = tails->find(tail);
+                if (cached == tails->end()) {
+                    batch_tails->misses++;
+                } else {
+                    batch_tails->hits++;
+                    ri.group = cached->second.group;
+                    ri.edition_info = cached->second.edition_info;
+                    ri.media_info = cached->second.media_info;
+                    if (!ri.show_info.has_value()) {
+                        ri.show_info = cached->second.show_info;
+                    }
+                    ri.release_type = resolve_release_type(ri, release_type);
+                    return {ri, parsing_result::pr_success};
+                }
+            }
+            bool show_in_title = ri.show_info.has_value();
 
             /*
              * Next, we check for the group name. It should be at the very back of the release name,
              * seperated from the rest by a minus.
              */
 
-            auto group_name_parts = split(release_name_parts.back(), "-");
-            if (group_name_parts.size() == 2) {
-                ri.group = group_name_parts.back();
-                /* we found the group name, but need to add the first part back the the release name parts, but
-                 * without the release group.
-                 */
-                release_name_parts.erase(release_name_parts.end());
-                release_name_parts.push_back(group_name_parts.front());
+            if (!release_name_parts.empty()) {
+                std::string &last_part = release_name_parts.back();
+                if (ends_with_group(last_part, group_hint)) {
+                    // the group the batch layout predicted, no need to split
+                    ri.group = group_hint;
+                    last_part.resize(last_part.size() - group_hint.size() - 1);
+                } else {
+                    auto group_name_parts = split(last_part, "-");
+                    if (group_name_parts.size() == 2) {
+                        ri.group = group_name_parts.back();
+                        /* we found the group name, but need to put the first part back into the release name parts,
+                         * but without the release group.
+                         */
+                        last_part = group_name_parts.front();
+                    }
+                }
             }
 
             /*
@@ -431,60 +1113,41 @@ namespace scene_name {
              * Normally, within elements of a show, we can find episode or season indication strings, such as:
              *
              * S01E02 - 1. season, 2. episode
+             * S01E02E03, S01E02-E05 - 1. season, multiple episodes
              * S01 - complete 1. season
+             * S01-S03 - complete seasons 1 to 3
+             * Complete.Series - everything
              *
              * Rarely, this weird representation also exists:
              *
              * 01x02 - 1. season, 2. episode
              *
-             * If we can't find any the Season, and we find indicators that the release has video elements,
-             * we consider it as non-movie and non-show - maybe music or documentary.
-             *
-             * It's also important to do this at the end, since the cpp regex implementation isn't the best,
-             * and it's the slowest operation by far here - so it makes sence to perform it on as little
-             * feature strings as possible.
+             * Shows without a year already had their marker consumed while extracting the title, so this only
+             * looks at the rest. The markers are parsed by hand, in the same walk over the parts that finds them.
              */
 
-            if (release_type == scene_release_info::scene_release_type::rt_unknown) {
-                // user wants us to guess the release type
-
-                for (auto& release_name_part : release_name_parts) {
-                    std::smatch season_match;
-                    std::smatch episode_match;
-                    if (std::regex_match(release_name_part, season_match, _season_regex)) {
-                        ri.release_type = scene_release_info::scene_release_type::rt_show;
-                        ri.show_info = {};
-                        ri.show_info->season =  std::stol(season_match.str());
-
-                        // is it an episode or a complete season?
-                        if (std::regex_match(release_name_part, episode_match, _episode_regex)) {
-                            if (episode_match.size() == 2) {
-                                std::ssub_match sub_match = episode_match[0];
-                                ri.show_info->episode = std::stol(sub_match.str());
-                            }
-                        } else {
-                            // we treat this release as a whole season
-                            ri.show_info->complete_season = true;
-                        }
-
-
-                        release_name_parts.erase(std::remove(release_name_parts.begin(), release_name_parts.end(), release_name_part), release_name_parts.end());
-
-
+            if (release_type != scene_release_info::scene_release_type::rt_movie && !ri.show_info.has_value()) {
+                for (std::size_t index = 0; index < release_name_parts.size(); index++) {
+                    scene_release_info::release_info_show show;
+                    std::size_t show_parts = match_show_parts(release_name_parts, index, show, false);
+                    if (show_parts > 0) {
+                        ri.show_info = show;
+                        trace(trace_event_type::te_show_found, release_name, show.season);
+                        release_name_parts.erase(release_name_parts.begin() + index,
+                                                 release_name_parts.begin() + index + show_parts);
                         break;
                     }
                 }
-
-            } else {
-                ri.release_type = release_type;
             }
 
+            ri.release_type = resolve_release_type(ri, release_type);
+
 
             /*
-             * As explained above, we check if the release year was found correctly.
+             * As explained above, we check if the title was found correctly, using the release year or a show marker.
              * If not - we try and extract the title by concatenating what's left of the feature parts.
              */
-            if (!ri.year.has_value()) {
+            if (!title_found) {
                 for (auto& release_name_part : release_name_parts) {
                     ri.name += release_name_part + " ";
                 }
@@ -499,6 +1162,10 @@ namespace scene_name {
 
             ri.media_info.features = {release_name_parts.begin(), release_name_parts.end()};
 
+            if (tails != nullptr) {
+                tails->emplace(tail, tail_info{ri.group, ri.edition_info, ri.media_info,
+                                               show_in_title ? std::nullopt : ri.show_info});
+            }
 
             return {ri, parsing_result::pr_success};
         };
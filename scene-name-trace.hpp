@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "scene-name-parser.hpp"
+
+namespace scene_name {
+
+    /**
+     * Bounded lock-free ring buffer sink. Any number of parsing threads may write into it,
+     * a single thread of the host application drains it.
+     *
+     * Events are dropped (and counted) while the buffer is full, the parsing threads never wait.
+     */
+    class trace_ring : public trace_sink {
+    private:
+        struct slot {
+            std::atomic<std::size_t> sequence;
+            trace_event event;
+        };
+
+        std::unique_ptr<slot[]> _slots;
+        std::size_t _mask;
+        alignas(64) std::atomic<std::size_t> _write_pos{0};
+        alignas(64) std::atomic<std::size_t> _read_pos{0};
+        alignas(64) std::atomic<std::size_t> _dropped{0};
+
+    public:
+        /**
+         * @param capacity number of events the buffer holds, rounded up to a power of two
+         */
+        explicit trace_ring(std::size_t capacity = 1024) {
+            std::size_t rounded_capacity = 2;
+            while (rounded_capacity < capacity) {
+                rounded_capacity *= 2;
+            }
+            _slots = std::make_unique<slot[]>(rounded_capacity);
+            _mask = rounded_capacity - 1;
+            for (std::size_t i = 0; i < rounded_capacity; i++) {
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        void trace(const trace_event &event) noexcept override {
+            std::size_t pos = _write_pos.load(std::memory_order_relaxed);
+            while (true) {
+                slot &current = _slots[pos & _mask];
+                std::size_t sequence = current.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence - pos);
+                if (difference == 0) {
+                    // slot is free, claim it
+                    if (_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        current.event = event;
+                        current.sequence.store(pos + 1, std::memory_order_release);
+                        return;
+                    }
+                } else if (difference < 0) {
+                    // the reader didn't get to this slot yet, we are full
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                } else {
+                    // another writer claimed it first
+                    pos = _write_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * Takes the oldest event out of the buffer. Only one thread may read at a time.
+         * @return if there was an event
+         */
+        bool try_pop(trace_event &event) noexcept {
+            std::size_t pos = _read_pos.load(std::memory_order_relaxed);
+            slot &current = _slots[pos & _mask];
+            if (current.sequence.load(std::memory_order_acquire) != pos + 1) {
+                return false;
+            }
+            event = current.event;
+            current.sequence.store(pos + _mask + 1, std::memory_order_release);
+            _read_pos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * Passes all buffered events to handler, oldest first. Only one thread may read at a time.
+         * @return the number of events drained
+         */
+        template<typename handler_type>
+        std::size_t drain(handler_type &&handler) {
+            std::size_t count = 0;
+            trace_event event;
+            while (try_pop(event)) {
+                handler(event);
+                count++;
+            }
+            return count;
+        }
+
+        /**
+         * @return the number of events dropped since the buffer was full
+         */
+        std::size_t dropped() const noexcept {
+            return _dropped.load(std::memory_order_relaxed);
+        }
+
+        std::size_t capacity() const noexcept {
+            return _mask + 1;
+        }
+    };
+
+}